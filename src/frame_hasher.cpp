@@ -0,0 +1,472 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "frame_hasher.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #include <nmmintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define CRC32C_TARGET
+    #else
+        #define CRC32C_TARGET __attribute__((target("sse4.2")))
+    #endif
+    #define CRC32C_HARDWARE
+    #define CRC32C_U64(crc, value) _mm_crc32_u64(crc, value)
+    #define CRC32C_U8(crc, value) _mm_crc32_u8(static_cast<uint32_t>(crc), value)
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    #include <arm_acle.h>
+    #define CRC32C_TARGET
+    #define CRC32C_HARDWARE
+    #define CRC32C_U64(crc, value) __crc32cd(static_cast<uint32_t>(crc), value)
+    #define CRC32C_U8(crc, value) __crc32cb(static_cast<uint32_t>(crc), value)
+#endif
+
+namespace
+{
+    constexpr uint32_t crc32c_polynomial = 0x82F63B78;
+
+    constexpr std::array<uint32_t, 256> crc32c_table = []()
+    {
+        std::array<uint32_t, 256> table{};
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? (crc >> 1) ^ crc32c_polynomial : crc >> 1;
+            table[i] = crc;
+        }
+        return table;
+    }();
+
+#if defined(CRC32C_HARDWARE)
+    CRC32C_TARGET uint64_t crc32c_hardware_update(uint64_t crc, const uint8_t* data, uint64_t size)
+    {
+        uint64_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t value;
+            memcpy(&value, data + i, sizeof(value));
+            crc = CRC32C_U64(crc, value);
+        }
+        for (; i < size; ++i)
+            crc = CRC32C_U8(crc, data[i]);
+        return crc;
+    }
+
+    // The crc32 instruction has a latency of several cycles but a throughput of one per cycle,
+    // so three independent stripes are hashed in lockstep to keep the unit busy.
+    CRC32C_TARGET void hash_stripes_hardware(const uint8_t* buffer, uint64_t buffer_size, unsigned int stripe_count, uint32_t* stripe_hashes)
+    {
+        const uint64_t stripe_size = buffer_size / stripe_count;
+        auto stripe_length = [&](unsigned int stripe) { return (stripe == stripe_count - 1) ? buffer_size - stripe * stripe_size : stripe_size; };
+
+        unsigned int stripe = 0;
+        for (; stripe + 3 <= stripe_count; stripe += 3)
+        {
+            const uint8_t* data_0 = buffer + stripe * stripe_size;
+            const uint8_t* data_1 = data_0 + stripe_size;
+            const uint8_t* data_2 = data_1 + stripe_size;
+            uint64_t crc_0 = 0xFFFFFFFF, crc_1 = 0xFFFFFFFF, crc_2 = 0xFFFFFFFF;
+
+            uint64_t i = 0;
+            for (; i + 8 <= stripe_size; i += 8)
+            {
+                uint64_t value_0, value_1, value_2;
+                memcpy(&value_0, data_0 + i, sizeof(value_0));
+                memcpy(&value_1, data_1 + i, sizeof(value_1));
+                memcpy(&value_2, data_2 + i, sizeof(value_2));
+                crc_0 = CRC32C_U64(crc_0, value_0);
+                crc_1 = CRC32C_U64(crc_1, value_1);
+                crc_2 = CRC32C_U64(crc_2, value_2);
+            }
+
+            stripe_hashes[stripe] = ~static_cast<uint32_t>(crc32c_hardware_update(crc_0, data_0 + i, stripe_length(stripe) - i));
+            stripe_hashes[stripe + 1] = ~static_cast<uint32_t>(crc32c_hardware_update(crc_1, data_1 + i, stripe_length(stripe + 1) - i));
+            stripe_hashes[stripe + 2] = ~static_cast<uint32_t>(crc32c_hardware_update(crc_2, data_2 + i, stripe_length(stripe + 2) - i));
+        }
+        for (; stripe < stripe_count; ++stripe)
+            stripe_hashes[stripe] = ~static_cast<uint32_t>(crc32c_hardware_update(0xFFFFFFFF, buffer + stripe * stripe_size, stripe_length(stripe)));
+    }
+#endif
+
+    bool detect_hardware_crc32c()
+    {
+#if defined(CRC32C_HARDWARE) && (defined(__x86_64__) || defined(_M_X64))
+    #if defined(_MSC_VER)
+        int cpu_info[4];
+        __cpuid(cpu_info, 1);
+        return (cpu_info[2] & (1 << 20)) != 0;
+    #else
+        return __builtin_cpu_supports("sse4.2");
+    #endif
+#elif defined(CRC32C_HARDWARE)
+        return true;
+#else
+        return false;
+#endif
+    }
+}
+
+FrameHasher::FrameHasher(unsigned int stripe_count, size_t log_capacity, std::atomic_bool& dump_is_requested, std::ostream& dump_stream)
+    : _stripe_count(stripe_count)
+    , _should_stop(false)
+    , _dump_is_requested(dump_is_requested)
+    , _dump_stream(dump_stream)
+    , _pending_is_valid(false)
+    , _pending_record{}
+    , _submitted_frames(0)
+    , _last_slots_dropped(0)
+    , _previous_hashes{}
+    , _has_previous(false)
+    , _previous_changed(false)
+    , _previous_changed_entirely(false)
+    , _run_follows_change(false)
+    , _repeat_count(0)
+    , _has_single_repeat(false)
+    , _last_single_repeat_index(0)
+    , _single_repeat_interval(0)
+    , _log(std::max<size_t>(log_capacity, 1))
+    , _log_next(0)
+{
+    if (stripe_count == 0 || stripe_count > max_stripe_count)
+        throw std::invalid_argument("Invalid stripe count");
+}
+
+FrameHasher::~FrameHasher()
+{
+    stop();
+}
+
+bool FrameHasher::start()
+{
+    _start_time = std::chrono::steady_clock::now();
+    _should_stop = false;
+    _worker_thread = std::thread(&FrameHasher::work, this);
+
+    return true;
+}
+
+bool FrameHasher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(_staging_mutex);
+        _should_stop = true;
+    }
+    _staging_condition.notify_one();
+    if (_worker_thread.joinable())
+        _worker_thread.join();
+
+    // a request raised after the worker returned is not lost either
+    serve_dump_request();
+
+    return true;
+}
+
+void FrameHasher::submit(const uint8_t* buffer, uint64_t buffer_size, uint64_t slots_dropped)
+{
+    if (!buffer)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(_staging_mutex);
+
+        if (slots_dropped > _last_slots_dropped)
+            _pending_record.dropped_frames += static_cast<uint32_t>(slots_dropped - _last_slots_dropped);
+        _last_slots_dropped = slots_dropped;
+
+        // the worker did not pick up the previous frame in time, it is overwritten and reported as skipped
+        if (_pending_is_valid)
+            ++_pending_record.skipped_frames;
+
+        _pending_buffer.resize(buffer_size);
+        memcpy(_pending_buffer.data(), buffer, buffer_size);
+        _pending_record.frame_index = _submitted_frames++;
+        _pending_record.timestamp = std::chrono::steady_clock::now();
+        _pending_is_valid = true;
+    }
+    _staging_condition.notify_one();
+}
+
+void FrameHasher::work()
+{
+    while (true)
+    {
+        Record record{};
+        bool should_stop = false;
+        bool has_frame = false;
+        {
+            // the dump flag is raised from a signal handler that cannot notify, hence the periodic wake up
+            std::unique_lock<std::mutex> lock(_staging_mutex);
+            _staging_condition.wait_for(lock, std::chrono::milliseconds(100), [this] { return _should_stop || _pending_is_valid || _dump_is_requested; });
+            should_stop = _should_stop;
+            if (!should_stop && _pending_is_valid)
+            {
+                std::swap(_pending_buffer, _working_buffer);
+                record = _pending_record;
+                _pending_record = Record{};
+                _pending_is_valid = false;
+                has_frame = true;
+            }
+        }
+
+        // a dump requested right before stop() is still served
+        serve_dump_request();
+        if (should_stop)
+            return;
+        if (!has_frame)
+            continue;
+
+        uint8_t previous_record_events = None;
+        record = analyze(record, previous_record_events);
+
+        std::lock_guard<std::mutex> lock(_log_mutex);
+        // a repeat can only be classified once the following frame is known
+        if (previous_record_events != None && _log_next > 0)
+        {
+            _log[(_log_next - 1) % _log.size()].events |= previous_record_events;
+            if (previous_record_events & Duplicated)
+                ++_statistics.duplicated_frames;
+            if (previous_record_events & Static)
+                ++_statistics.static_frames;
+            if (previous_record_events & Cadence)
+                ++_statistics.cadence_frames;
+        }
+        _log[_log_next % _log.size()] = record;
+        ++_log_next;
+
+        ++_statistics.hashed_frames;
+        if (record.events & Repeated)
+            ++_statistics.repeated_frames;
+        if (record.events & Static)
+            ++_statistics.static_frames;
+        if (record.events & PartialChange)
+            ++_statistics.partial_changes;
+        if (record.events & Gap)
+            ++_statistics.gaps;
+        if (record.events & Skipped)
+            ++_statistics.skips;
+        _statistics.dropped_frames += record.dropped_frames;
+        _statistics.skipped_frames += record.skipped_frames;
+    }
+}
+
+void FrameHasher::serve_dump_request()
+{
+    if (!_dump_is_requested.exchange(false))
+        return;
+
+    // a single write, so the log is not interleaved with the status line
+    _dump_stream << '\n' + format_log() << std::flush;
+}
+
+FrameHasher::Record FrameHasher::analyze(Record record, uint8_t& previous_record_events)
+{
+    std::array<uint32_t, max_stripe_count> stripe_hashes{};
+    hash_stripes(_working_buffer.data(), _working_buffer.size(), _stripe_count, stripe_hashes.data());
+
+    record.frame_hash = crc32c(reinterpret_cast<const uint8_t*>(stripe_hashes.data()), _stripe_count * sizeof(uint32_t));
+    if (record.dropped_frames > 0)
+        record.events |= Gap;
+    if (record.skipped_frames > 0)
+        record.events |= Skipped;
+
+    if (_has_previous)
+    {
+        for (unsigned int stripe = 0; stripe < _stripe_count; ++stripe)
+        {
+            if (stripe_hashes[stripe] != _previous_hashes[stripe])
+                record.changed_stripes |= 1u << stripe;
+        }
+
+        const uint32_t all_stripes = (_stripe_count == 32) ? 0xFFFFFFFF : (1u << _stripe_count) - 1;
+        if (record.dropped_frames > 0 || record.skipped_frames > 0)
+        {
+            // the previous hashed frame was not adjacent to this one, classifying against it would be meaningless
+            _repeat_count = 0;
+            _run_follows_change = false;
+            _previous_changed = false;
+            _previous_changed_entirely = false;
+            _has_single_repeat = false;
+            _single_repeat_interval = 0;
+        }
+        else if (record.changed_stripes == 0)
+        {
+            if (_repeat_count == 0)
+                _run_follows_change = _previous_changed;
+            ++_repeat_count;
+
+            record.events |= Repeated;
+            if (_repeat_count >= 2)
+                record.events |= Static;
+            if (_repeat_count == 2)
+                previous_record_events |= Static;
+            _previous_changed = false;
+            _previous_changed_entirely = false;
+        }
+        else
+        {
+            if (_repeat_count == 1 && _run_follows_change)
+            {
+                // the repeated frame is the previous one, adjacent since this frame carries no gap
+                const uint64_t repeat_index = record.frame_index - 1;
+                bool follows_cadence = false;
+                if (_has_single_repeat)
+                {
+                    const uint64_t interval = repeat_index - _last_single_repeat_index;
+                    follows_cadence = (interval == _single_repeat_interval);
+                    _single_repeat_interval = interval;
+                }
+                _has_single_repeat = true;
+                _last_single_repeat_index = repeat_index;
+
+                previous_record_events |= follows_cadence ? Cadence : Duplicated;
+            }
+            _repeat_count = 0;
+            // a moving picture suddenly leaving some stripes untouched hints at a torn frame
+            if (record.changed_stripes != all_stripes && _previous_changed_entirely)
+                record.events |= PartialChange;
+            _previous_changed = true;
+            _previous_changed_entirely = (record.changed_stripes == all_stripes);
+        }
+    }
+    record.repeat_count = _repeat_count;
+
+    _previous_hashes = stripe_hashes;
+    _has_previous = true;
+
+    return record;
+}
+
+FrameHasher::Statistics FrameHasher::statistics() const
+{
+    std::lock_guard<std::mutex> lock(_log_mutex);
+    return _statistics;
+}
+
+void FrameHasher::dump(std::ostream& os) const
+{
+    os << format_log() << std::flush;
+}
+
+std::string FrameHasher::format_log() const
+{
+    std::vector<Record> records;
+    Statistics statistics;
+    {
+        std::lock_guard<std::mutex> lock(_log_mutex);
+        const size_t count = std::min(_log_next, _log.size());
+        records.reserve(count);
+        for (size_t i = _log_next - count; i < _log_next; ++i)
+            records.push_back(_log[i % _log.size()]);
+        statistics = _statistics;
+    }
+
+    std::ostringstream text;
+    text << "Frame hash log (" << statistics.hashed_frames << " frames hashed, "
+                               << statistics.repeated_frames << " repeated ("
+                               << statistics.duplicated_frames << " duplicated, "
+                               << statistics.static_frames << " static, "
+                               << statistics.cadence_frames << " cadence), "
+                               << statistics.partial_changes << " partial changes, "
+                               << statistics.gaps << " gaps (" << statistics.dropped_frames << " frames dropped by the board), "
+                               << statistics.skips << " skips (" << statistics.skipped_frames << " frames skipped by the hasher))\n";
+
+    for (const Record& record : records)
+    {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(record.timestamp - _start_time).count();
+
+        text << "\t" << "#" << record.frame_index << " +" << elapsed << "ms"
+             << std::hex << std::setfill('0')
+             << " hash=0x" << std::setw(8) << record.frame_hash
+             << " changed=0x" << std::setw(8) << record.changed_stripes
+             << std::dec << std::setfill(' ');
+        if (record.events & Duplicated)
+            text << " DUPLICATED";
+        else if (record.events & Cadence)
+            text << " CADENCE";
+        else if (record.events & Static)
+            text << " STATIC(x" << record.repeat_count << ")";
+        else if (record.events & Repeated)
+            text << " REPEATED(x" << record.repeat_count << ")";
+        if (record.events & PartialChange)
+            text << " PARTIAL";
+        if (record.events & Gap)
+            text << " GAP(" << record.dropped_frames << ")";
+        if (record.events & Skipped)
+            text << " SKIPPED(" << record.skipped_frames << ")";
+        text << '\n';
+    }
+
+    return text.str();
+}
+
+bool FrameHasher::hardware_accelerated()
+{
+    static const bool supported = detect_hardware_crc32c();
+    return supported;
+}
+
+uint32_t FrameHasher::crc32c(const uint8_t* data, uint64_t size)
+{
+#if defined(CRC32C_HARDWARE)
+    if (hardware_accelerated())
+        return ~static_cast<uint32_t>(crc32c_hardware_update(0xFFFFFFFF, data, size));
+#endif
+    return crc32c_software(data, size);
+}
+
+void FrameHasher::hash_stripes(const uint8_t* buffer, uint64_t buffer_size, unsigned int stripe_count, uint32_t* stripe_hashes)
+{
+    if (stripe_count == 0)
+        return;
+
+#if defined(CRC32C_HARDWARE)
+    if (hardware_accelerated())
+    {
+        hash_stripes_hardware(buffer, buffer_size, stripe_count, stripe_hashes);
+        return;
+    }
+#endif
+    hash_stripes_software(buffer, buffer_size, stripe_count, stripe_hashes);
+}
+
+uint32_t FrameHasher::crc32c_software(const uint8_t* data, uint64_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    for (uint64_t i = 0; i < size; ++i)
+        crc = crc32c_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+void FrameHasher::hash_stripes_software(const uint8_t* buffer, uint64_t buffer_size, unsigned int stripe_count, uint32_t* stripe_hashes)
+{
+    if (stripe_count == 0)
+        return;
+
+    const uint64_t stripe_size = buffer_size / stripe_count;
+    for (unsigned int stripe = 0; stripe < stripe_count; ++stripe)
+    {
+        uint64_t length = (stripe == stripe_count - 1) ? buffer_size - stripe * stripe_size : stripe_size;
+        stripe_hashes[stripe] = crc32c_software(buffer + stripe * stripe_size, length);
+    }
+}
\ No newline at end of file
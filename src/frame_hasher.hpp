@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Hashes every submitted frame (CRC32C, hardware accelerated when available) on a worker thread,
+// split into horizontal stripes, and keeps a ring-buffered log of the results.
+// Consecutive frames are compared to flag repeated frames, partially updated frames and gaps.
+// An isolated repeat inside a moving picture is reported as a duplicated frame, unless isolated repeats occur at a
+// regular interval (e.g. 30p content carried in a 60p signal), and longer runs as a static picture.
+// Frames dropped by the board (gaps) are reported separately from frames the hasher skipped because it fell behind.
+// The log is written to the dump stream by the worker whenever the dump flag is raised, regardless of the capture loop.
+class FrameHasher
+{
+public:
+    static constexpr unsigned int max_stripe_count = 32;
+
+    enum Event : uint8_t
+    {
+        None = 0,
+        Repeated = 1 << 0,       // every stripe is identical to the previous frame
+        PartialChange = 1 << 1,  // only some stripes changed while the previous frame changed entirely
+        Gap = 1 << 2,            // frames were dropped by the board before this one
+        Skipped = 1 << 3,        // frames were overwritten before the hasher could process them
+        Duplicated = 1 << 4,     // single repeat between two changing frames
+        Static = 1 << 5,         // part of a run of at least two repeats
+        Cadence = 1 << 6,        // single repeat at the same interval as the previous single repeat
+    };
+
+    struct Record
+    {
+        uint64_t frame_index;
+        std::chrono::steady_clock::time_point timestamp;
+        uint32_t frame_hash;
+        uint32_t changed_stripes;  // bitmask, stripe 0 is the top of the frame
+        uint32_t repeat_count;
+        uint32_t dropped_frames;
+        uint32_t skipped_frames;
+        uint8_t events;
+    };
+
+    struct Statistics
+    {
+        uint64_t hashed_frames = 0;
+        uint64_t repeated_frames = 0;
+        uint64_t duplicated_frames = 0;
+        uint64_t static_frames = 0;
+        uint64_t cadence_frames = 0;
+        uint64_t partial_changes = 0;
+        uint64_t gaps = 0;
+        uint64_t dropped_frames = 0;
+        uint64_t skips = 0;
+        uint64_t skipped_frames = 0;
+    };
+
+    FrameHasher(unsigned int stripe_count, size_t log_capacity, std::atomic_bool& dump_is_requested, std::ostream& dump_stream);
+    ~FrameHasher();
+
+    FrameHasher(const FrameHasher&) = delete;
+    FrameHasher& operator=(const FrameHasher&) = delete;
+    FrameHasher(FrameHasher&&) = delete;
+    FrameHasher& operator=(FrameHasher&&) = delete;
+
+    bool start();
+    void submit(const uint8_t* buffer, uint64_t buffer_size, uint64_t slots_dropped);
+    bool stop();
+
+    Statistics statistics() const;
+    void dump(std::ostream& os) const;
+
+    static bool hardware_accelerated();
+    static uint32_t crc32c(const uint8_t* data, uint64_t size);
+    static void hash_stripes(const uint8_t* buffer, uint64_t buffer_size, unsigned int stripe_count, uint32_t* stripe_hashes);
+
+    // table driven reference implementation, used when no hardware support is available
+    static uint32_t crc32c_software(const uint8_t* data, uint64_t size);
+    static void hash_stripes_software(const uint8_t* buffer, uint64_t buffer_size, unsigned int stripe_count, uint32_t* stripe_hashes);
+
+private:
+    unsigned int _stripe_count;
+    std::chrono::steady_clock::time_point _start_time;
+
+    std::thread _worker_thread;
+    bool _should_stop;
+    std::atomic_bool& _dump_is_requested;
+    std::ostream& _dump_stream;
+
+    std::mutex _staging_mutex;
+    std::condition_variable _staging_condition;
+    std::vector<uint8_t> _pending_buffer;
+    std::vector<uint8_t> _working_buffer;
+    bool _pending_is_valid;
+    Record _pending_record;  // capture information of the pending frame, completed by the worker
+    uint64_t _submitted_frames;
+    uint64_t _last_slots_dropped;
+
+    std::array<uint32_t, max_stripe_count> _previous_hashes;
+    bool _has_previous;
+    bool _previous_changed;
+    bool _previous_changed_entirely;
+    bool _run_follows_change;
+    uint32_t _repeat_count;
+    bool _has_single_repeat;
+    uint64_t _last_single_repeat_index;
+    uint64_t _single_repeat_interval;
+
+    mutable std::mutex _log_mutex;
+    std::vector<Record> _log;
+    size_t _log_next;
+    Statistics _statistics;
+
+    void work();
+    void serve_dump_request();
+    std::string format_log() const;
+    Record analyze(Record record, uint8_t& previous_record_events);
+};
\ No newline at end of file
@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) DELTACAST.TV. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at * * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "frame_hasher.hpp"
+
+// Checks the dispatched implementation against the CRC32C check value and the software reference
+bool verify()
+{
+    const uint8_t check_input[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    constexpr uint32_t check_value = 0xE3069283;
+    if (FrameHasher::crc32c(check_input, sizeof(check_input)) != check_value
+        || FrameHasher::crc32c_software(check_input, sizeof(check_input)) != check_value)
+    {
+        std::cerr << "ERROR: CRC32C check value mismatch" << std::endl;
+        return false;
+    }
+
+    std::vector<uint8_t> data(100003 + 1);
+    for (uint64_t i = 0; i < data.size(); ++i)
+        data[i] = static_cast<uint8_t>(i * 2654435761u >> 24);
+
+    for (uint64_t size : { 0, 1, 7, 8, 9, 23, 24, 25, 1000, 4099, 100003 })
+    {
+        for (unsigned int stripe_count : { 1u, 2u, 3u, 4u, 5u, 6u, 7u, 16u, 31u, FrameHasher::max_stripe_count })
+        {
+            // an odd offset makes sure unaligned buffers are handled as well
+            for (uint64_t offset : { 0, 1 })
+            {
+                uint32_t expected[FrameHasher::max_stripe_count];
+                uint32_t actual[FrameHasher::max_stripe_count];
+                FrameHasher::hash_stripes_software(data.data() + offset, size, stripe_count, expected);
+                FrameHasher::hash_stripes(data.data() + offset, size, stripe_count, actual);
+                for (unsigned int stripe = 0; stripe < stripe_count; ++stripe)
+                {
+                    if (actual[stripe] != expected[stripe])
+                    {
+                        std::cerr << "ERROR: stripe hash mismatch (size: " << size << ", stripes: " << stripe_count
+                                                                        << ", offset: " << offset << ", stripe: " << stripe << ")" << std::endl;
+                        return false;
+                    }
+                }
+            }
+        }
+
+        if (FrameHasher::crc32c(data.data() + 1, size) != FrameHasher::crc32c_software(data.data() + 1, size))
+        {
+            std::cerr << "ERROR: CRC32C mismatch (size: " << size << ")" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Measures the single core throughput of the frame hashing stage on a 2160p YUV422 8-bit buffer
+int main()
+{
+    if (!verify())
+        return -1;
+
+    constexpr uint64_t width = 3840;
+    constexpr uint64_t height = 2160;
+    constexpr uint64_t frame_size = width * height * 2;
+    constexpr unsigned int stripe_count = 16;
+    constexpr int iterations = 200;
+
+    std::vector<uint8_t> frame(frame_size);
+    for (uint64_t i = 0; i < frame_size; ++i)
+        frame[i] = static_cast<uint8_t>(i * 2654435761u >> 24);
+
+    uint32_t stripe_hashes[stripe_count];
+    uint32_t checksum = 0;
+
+    FrameHasher::hash_stripes(frame.data(), frame.size(), stripe_count, stripe_hashes);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        frame[i] ^= 1;
+        FrameHasher::hash_stripes(frame.data(), frame.size(), stripe_count, stripe_hashes);
+        checksum ^= stripe_hashes[0];
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double bytes = static_cast<double>(frame_size) * iterations;
+    std::cout << "CRC32C implementation: " << (FrameHasher::hardware_accelerated() ? "hardware" : "software") << std::endl;
+    std::cout << "Frame: " << width << "x" << height << " YUV422 8-bit, " << stripe_count << " stripes" << std::endl;
+    std::cout << "Throughput: " << bytes / elapsed.count() / 1e9 << " GB/s per core" << std::endl;
+    std::cout << "Frame rate: " << iterations / elapsed.count() << " fps per core (2160p60 requires 60)" << std::endl;
+    std::cout << "Checksum: 0x" << std::hex << checksum << std::dec << std::endl;
+
+    return 0;
+}
\ No newline at end of file
@@ -18,6 +18,7 @@
 #include <csignal>
 #include <atomic>
 #include <memory>
+#include <sstream>
 
 #include <VideoMasterCppApi/exception.hpp>
 #include <VideoMasterCppApi/to_string.hpp>
@@ -30,6 +31,7 @@
 #include "helper.hpp"
 #include "shared_resources.hpp"
 #include "windowed_renderer.hpp"
+#include "frame_hasher.hpp"
 
 using namespace std::chrono_literals;
 using namespace Deltacast::Wrapper;
@@ -41,6 +43,17 @@ void on_close(int /*signal*/)
     shared_resources.stop_is_requested = true;
 }
 
+void on_hash_log_dump(int signal_number)
+{
+#if defined(_WIN32)
+    // the Windows CRT resets the handler to SIG_DFL before calling it
+    signal(signal_number, on_hash_log_dump);
+#else
+    (void)signal_number;
+#endif
+    shared_resources.hash_log_dump_requested = true;
+}
+
 int main(int argc, char** argv)
 {
     CLI::App app{"Identify an incoming signal and display it on the screen"};
@@ -49,6 +62,14 @@ int main(int argc, char** argv)
     app.add_option("-d,--device", device_id, "ID of the device to use");
     int rx_stream_id = 0;
     app.add_option("-i,--input", rx_stream_id, "ID of the input connector to use");
+    bool hash_enabled = false;
+    app.add_flag("--hash", hash_enabled, "Hash every frame to detect repeated, partially updated and missing frames");
+    unsigned int hash_stripes = 16;
+    app.add_option("--hash-stripes", hash_stripes, "Number of horizontal stripes hashed separately")
+        ->check(CLI::Range(1u, FrameHasher::max_stripe_count));
+    size_t hash_log_size = 1024;
+    app.add_option("--hash-log-size", hash_log_size, "Number of frames kept in the hash log")
+        ->check(CLI::PositiveNumber);
     CLI11_PARSE(app, argc, argv);
 
     signal(SIGINT, on_close);
@@ -105,6 +126,22 @@ int main(int argc, char** argv)
 
             std::cout << std::endl;
 
+            std::unique_ptr<FrameHasher> frame_hasher;
+            if (hash_enabled)
+            {
+                std::cout << "Starting frame hasher (" << (FrameHasher::hardware_accelerated() ? "hardware" : "software") << " CRC32C, "
+                                                       << hash_stripes << " stripes)..." << std::endl;
+#if defined(SIGUSR1)
+                signal(SIGUSR1, on_hash_log_dump);
+                std::cout << "Send SIGUSR1 to dump the hash log" << std::endl;
+#elif defined(SIGBREAK)
+                signal(SIGBREAK, on_hash_log_dump);
+                std::cout << "Press Ctrl+Break to dump the hash log" << std::endl;
+#endif
+                frame_hasher = std::make_unique<FrameHasher>(hash_stripes, hash_log_size, shared_resources.hash_log_dump_requested, std::cout);
+                frame_hasher->start();
+            }
+
             std::cout << "Starting RX stream..." << std::endl;
             rx_stream.start();
             
@@ -127,13 +164,33 @@ int main(int argc, char** argv)
                     auto [ buffer, buffer_size ] = slot->video().buffer();
                     
                     renderer.render_buffer(buffer, buffer_size);
+                    if (frame_hasher)
+                        frame_hasher->submit(buffer, buffer_size, rx_stream.buffer_queue().slots_dropped());
                 }
 
-                std::cout << "Slots count: " << rx_stream.buffer_queue().slots_count() 
-                                             << " (dropped: " << rx_stream.buffer_queue().slots_dropped() << ")" << "\r";
+                // built first and written at once, the frame hasher may dump its log to std::cout concurrently
+                std::ostringstream status;
+                status << "Slots count: " << rx_stream.buffer_queue().slots_count() 
+                                          << " (dropped: " << rx_stream.buffer_queue().slots_dropped() << ")";
+                if (frame_hasher)
+                {
+                    auto hash_statistics = frame_hasher->statistics();
+                    status << " - Hashed: " << hash_statistics.hashed_frames 
+                                            << " (duplicated: " << hash_statistics.duplicated_frames
+                                            << ", static: " << hash_statistics.static_frames
+                                            << ", cadence: " << hash_statistics.cadence_frames
+                                            << ", partial: " << hash_statistics.partial_changes
+                                            << ", gaps: " << hash_statistics.gaps
+                                            << ", skipped: " << hash_statistics.skipped_frames << ")";
+                }
+                status << "\r";
+                std::cout << status.str() << std::flush;
             }
 
             std::cout << std::endl;
+
+            if (frame_hasher)
+                frame_hasher->stop();
         }
     }
     catch (const ApiException& e)
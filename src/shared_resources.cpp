@@ -19,4 +19,5 @@ void Deltacast::SharedResources::reset()
 {
     stop_is_requested = false;
     incoming_signal_changed = false;
+    hash_log_dump_requested = false;
 }
\ No newline at end of file
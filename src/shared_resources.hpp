@@ -24,6 +24,7 @@ namespace Deltacast
     {
         std::atomic_bool stop_is_requested{false};
         std::atomic_bool incoming_signal_changed{false};
+        std::atomic_bool hash_log_dump_requested{false};
 
         void reset();
     };